@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stack>
+#include <queue>
+#include <vector>
 
 // 交通方式枚举
 enum TransportMode {
@@ -26,6 +28,9 @@ typedef struct GraphMatrix {
     int** timeRoad;              // 公路时间矩阵
     int** timeRailway;           // 铁路时间矩阵
     int** timeAir;               // 航空时间矩阵
+    int* componentParent[7];     // 各交通方式组合下的并查集父节点数组，下标为掩码减一
+    int* componentSize[7];       // 各并查集中以该节点为根的分量大小
+    int componentDirty[7];       // 删除连接后置1，查询时惰性重建
 } GraphMatrix;
 
 // 搜索维度枚举
@@ -34,6 +39,51 @@ enum SearchDimension {
     BY_TIME
 };
 
+// 多对多距离矩阵查询中一次批量搜索的出发城市个数（与位掩码的位数一致）
+#define MATRIX_BLOCK 64
+#define MATRIX_INFINITY 0x3fffffff
+
+// 备选路线结构体（K短路查询结果）
+typedef struct RoutePath {
+    int length;                  // 路径上的节点个数
+    int* vex;                    // 节点序列，vex[0]为起点
+    enum TransportMode* mode;    // mode[i]为vex[i-1]到vex[i]所用的交通方式，mode[0]无意义
+    int total;                   // 按搜索维度累计的总费用或总时间
+    int deviation;               // 与上一条路线的偏离位置，用于减少重复的偏离点搜索
+} RoutePath;
+
+// 紧凑邻接表中的一条边
+typedef struct ModeEdge {
+    int to;                      // 终点城市编号
+    enum TransportMode mode;     // 交通方式
+    int value;                   // 搜索维度上的权值
+} ModeEdge;
+
+// 紧凑邻接表的构建缓冲区，边数组按字节存放，可用于不同的边结构体
+typedef struct EdgeBuffer {
+    int* offsets;                // 各节点出边在边数组中的起始位置
+    char* edges;                 // 边数组
+    int count;                   // 已有的边数
+    int capacity;                // 边数组的容量
+    int edgeSize;                // 单条边结构体的大小
+} EdgeBuffer;
+
+// 预算可达查询的结果
+typedef struct ReachInfo {
+    int city;                    // 可达城市编号
+    int value;                   // 搜索维度上的最小值
+    int other;                   // 对应路线在另一维度上的值
+    PreInfo pre;                 // 到达该城市的最后一段：前驱城市和交通方式
+} ReachInfo;
+
+// 预算查询使用的紧凑边
+typedef struct BudgetEdge {
+    int to;                      // 终点城市编号
+    enum TransportMode mode;     // 交通方式
+    int value;                   // 搜索维度上的权值
+    int other;                   // 另一维度上的权值
+} BudgetEdge;
+
 // 函数原型声明
 int findCityIndex(GraphMatrix* graph, const char* cityName);
 int addCity(GraphMatrix* graph, const char* cityName);
@@ -47,6 +97,46 @@ void printPath(GraphMatrix* graph, int start, int end, int* dist, PreInfo* pre,
 void showCities(GraphMatrix* graph);
 void addConnection(GraphMatrix* graph, const char* fromCity, const char* toCity, enum TransportMode mode, int cost, int time);
 void removeConnection(GraphMatrix* graph, const char* fromCity, const char* toCity, enum TransportMode mode);
+int getEdgeWeight(GraphMatrix* graph, int u, int v, enum TransportMode mode, enum SearchDimension dimension);
+int** getWeightMatrix(GraphMatrix* graph, enum TransportMode mode, enum SearchDimension dimension);
+int initEdgeBuffer(EdgeBuffer* buffer, int n, int edgeSize);
+void* appendEdge(EdgeBuffer* buffer);
+int buildModeEdges(GraphMatrix* graph, int allowRoad, int allowRailway, int allowAir,
+                   enum SearchDimension dimension, int** offsets, ModeEdge** edges);
+int searchModeEdges(const int* offsets, const ModeEdge* edges, int start, int end, const int* h,
+                    const int* blockedVex, const int* blockedEdge, int* dist, PreInfo* pre, int* visited, int* touched);
+int kShortestPaths(GraphMatrix* graph, int start, int end, int k, RoutePath* paths,
+                   int allowRoad, int allowRailway, int allowAir, enum SearchDimension dimension);
+void printRoutePath(GraphMatrix* graph, RoutePath* path, int rank, enum SearchDimension dimension);
+void freeRoutePath(RoutePath* path);
+enum SearchDimension readSearchDimension();
+void readTransportModes(int* allowRoad, int* allowRailway, int* allowAir);
+int readCityList(GraphMatrix* graph, const char* prompt, int* indices, int maxCount);
+int isSameRoute(RoutePath* a, RoutePath* b);
+int buildMergedEdges(GraphMatrix* graph, int allowRoad, int allowRailway, int allowAir,
+                     enum SearchDimension dimension, int** offsets, ModeEdge** edges);
+void searchSourceBlock(int n, const int* offsets, const ModeEdge* edges, const int* block, int blockCount,
+                       unsigned long long* need, int needCount, int* dist, unsigned long long* dirty, int* pending);
+int distanceMatrix(GraphMatrix* graph, const int* sources, int sourceCount, const int* targets, int targetCount,
+                   int allowRoad, int allowRailway, int allowAir, enum SearchDimension dimension, int* result);
+int buildBudgetEdges(GraphMatrix* graph, int allowRoad, int allowRailway, int allowAir,
+                     enum SearchDimension dimension, int** offsets, BudgetEdge** edges);
+int searchWithinBudget(GraphMatrix* graph, const int* allow, enum SearchDimension dimension,
+                       const int* offsets, const BudgetEdge* edges, int start, int budget, int otherBudget,
+                       ReachInfo* result, int* minOther, int* reached);
+int reachableWithinBudgetBatch(GraphMatrix* graph, const int* origins, int originCount, enum SearchDimension dimension,
+                               int budget, int otherBudget, int allowRoad, int allowRailway, int allowAir,
+                               ReachInfo* results, int* counts);
+int reachableWithinBudget(GraphMatrix* graph, int start, enum SearchDimension dimension, int budget, int otherBudget,
+                          int allowRoad, int allowRailway, int allowAir, ReachInfo* result);
+int getModeMask(int allowRoad, int allowRailway, int allowAir);
+int findComponent(int* parent, int x);
+void unionComponents(int* parent, int* size, int a, int b);
+void rebuildComponents(GraphMatrix* graph, int masks);
+void buildConnectivityIndex(GraphMatrix* graph);
+int isConnected(GraphMatrix* graph, int a, int b, int allowRoad, int allowRailway, int allowAir);
+void permuteMatrix(int** matrix, int n, const int* order, int** rowBuffer, int* colBuffer);
+int reorderGraph(GraphMatrix* graph);
 
 // 查找城市在数组中的索引
 int findCityIndex(GraphMatrix* graph, const char* cityName) {
@@ -130,6 +220,28 @@ int addCity(GraphMatrix* graph, const char* cityName) {
     graph->timeAir = newTimeAirMatrix;
     graph->timeAir[graph->size] = (int*)malloc(newSize * sizeof(int));
     
+    // 已有的行也要扩展一列，否则下面初始化新增列时会越界
+    for (int i = 0; i < graph->size; i++) {
+        int* rows[6];
+        rows[0] = (int*)realloc(graph->graphRoad[i], newSize * sizeof(int));
+        if (rows[0]) graph->graphRoad[i] = rows[0];
+        rows[1] = (int*)realloc(graph->graphRailway[i], newSize * sizeof(int));
+        if (rows[1]) graph->graphRailway[i] = rows[1];
+        rows[2] = (int*)realloc(graph->graphAir[i], newSize * sizeof(int));
+        if (rows[2]) graph->graphAir[i] = rows[2];
+        rows[3] = (int*)realloc(graph->timeRoad[i], newSize * sizeof(int));
+        if (rows[3]) graph->timeRoad[i] = rows[3];
+        rows[4] = (int*)realloc(graph->timeRailway[i], newSize * sizeof(int));
+        if (rows[4]) graph->timeRailway[i] = rows[4];
+        rows[5] = (int*)realloc(graph->timeAir[i], newSize * sizeof(int));
+        if (rows[5]) graph->timeAir[i] = rows[5];
+        for (int j = 0; j < 6; j++) {
+            if (!rows[j]) {
+                return -1;
+            }
+        }
+    }
+    
     // 初始化新增的行列，设置为无穷大（用-1表示）
     for (int i = 0; i < newSize; i++) {
         graph->graphRoad[i][graph->size] = -1;
@@ -149,6 +261,23 @@ int addCity(GraphMatrix* graph, const char* cityName) {
         }
     }
     
+    // 新城市在各连通分量索引中是一个单独的分量
+    for (int mask = 0; mask < 7; mask++) {
+        int* newParent = (int*)realloc(graph->componentParent[mask], newSize * sizeof(int));
+        if (!newParent) {
+            return -1;
+        }
+        graph->componentParent[mask] = newParent;
+        graph->componentParent[mask][graph->size] = graph->size;
+        
+        int* newComponentSize = (int*)realloc(graph->componentSize[mask], newSize * sizeof(int));
+        if (!newComponentSize) {
+            return -1;
+        }
+        graph->componentSize[mask] = newComponentSize;
+        graph->componentSize[mask][graph->size] = 1;
+    }
+    
     int result = graph->size;
     graph->size++;
     return result;
@@ -169,6 +298,11 @@ GraphMatrix* createGraph() {
     graph->timeRoad = NULL;
     graph->timeRailway = NULL;
     graph->timeAir = NULL;
+    for (int i = 0; i < 7; i++) {
+        graph->componentParent[i] = NULL;
+        graph->componentSize[i] = NULL;
+        graph->componentDirty[i] = 1;
+    }
     
     return graph;
 }
@@ -267,6 +401,12 @@ GraphMatrix* readTransportData(const char* filename) {
     }
     
     fclose(file);
+    
+    // 按读入顺序编号的相邻城市在内存中较分散，重新编号以改善访问局部性；
+    // 重排同时构建连通分量索引，内存不足时保持原顺序单独构建
+    if (reorderGraph(graph) != 0) {
+        buildConnectivityIndex(graph);
+    }
     return graph;
 }
 
@@ -410,252 +550,1463 @@ void printPath(GraphMatrix* graph, int start, int end, int* dist, PreInfo* pre,
     printf("\n");
 }
 
-// 销毁图
-void destroyGraph(GraphMatrix* graph) {
-    if (!graph) {
-        return;
+// 获取指定交通方式下边(u, v)在搜索维度上的权值，不存在时返回-1
+int getEdgeWeight(GraphMatrix* graph, int u, int v, enum TransportMode mode, enum SearchDimension dimension) {
+    switch (mode) {
+        case ROAD:
+            return (dimension == BY_COST) ? graph->graphRoad[u][v] : graph->timeRoad[u][v];
+        case RAILWAY:
+            return (dimension == BY_COST) ? graph->graphRailway[u][v] : graph->timeRailway[u][v];
+        case AIR:
+            return (dimension == BY_COST) ? graph->graphAir[u][v] : graph->timeAir[u][v];
+        default:
+            return -1;
     }
-    
-    // 释放城市名称数组
-    for (int i = 0; i < graph->size; i++) {
-        free(graph->city[i]);
+}
+
+// 获取指定交通方式在搜索维度上的权值矩阵
+int** getWeightMatrix(GraphMatrix* graph, enum TransportMode mode, enum SearchDimension dimension) {
+    switch (mode) {
+        case ROAD:
+            return (dimension == BY_COST) ? graph->graphRoad : graph->timeRoad;
+        case RAILWAY:
+            return (dimension == BY_COST) ? graph->graphRailway : graph->timeRailway;
+        default:
+            return (dimension == BY_COST) ? graph->graphAir : graph->timeAir;
     }
-    free(graph->city);
-    
-    // 释放邻接矩阵
-    for (int i = 0; i < graph->size; i++) {
-        if (graph->graphRoad) free(graph->graphRoad[i]);
-        if (graph->graphRailway) free(graph->graphRailway[i]);
-        if (graph->graphAir) free(graph->graphAir[i]);
-        if (graph->timeRoad) free(graph->timeRoad[i]);
-        if (graph->timeRailway) free(graph->timeRailway[i]);
-        if (graph->timeAir) free(graph->timeAir[i]);
+}
+
+// 初始化紧凑邻接表的构建缓冲区，edgeSize为单条边结构体的大小，成功返回0
+int initEdgeBuffer(EdgeBuffer* buffer, int n, int edgeSize) {
+    buffer->count = 0;
+    buffer->capacity = 4 * n + 1;
+    buffer->edgeSize = edgeSize;
+    buffer->offsets = (int*)malloc((n + 1) * sizeof(int));
+    buffer->edges = (char*)malloc((size_t)buffer->capacity * edgeSize);
+    if (!buffer->offsets || !buffer->edges) {
+        free(buffer->offsets);
+        free(buffer->edges);
+        buffer->offsets = NULL;
+        buffer->edges = NULL;
+        return -1;
     }
-    free(graph->graphRoad);
-    free(graph->graphRailway);
-    free(graph->graphAir);
-    free(graph->timeRoad);
-    free(graph->timeRailway);
-    free(graph->timeAir);
-    
-    free(graph);
+    return 0;
 }
 
-// 显示所有城市
-void showCities(GraphMatrix* graph) {
-    printf("\nAvailable cities:\n");
-    printf("----------------\n");
-    for (int i = 0; i < graph->size; i++) {
-        printf("%d. %s\n", i + 1, graph->city[i]);
+// 在缓冲区末尾追加一条边并返回它的位置，容量不足时倍增；内存不足时释放整个缓冲区并返回NULL
+void* appendEdge(EdgeBuffer* buffer) {
+    if (buffer->count == buffer->capacity) {
+        char* newEdges = (char*)realloc(buffer->edges, (size_t)2 * buffer->capacity * buffer->edgeSize);
+        if (!newEdges) {
+            free(buffer->offsets);
+            free(buffer->edges);
+            buffer->offsets = NULL;
+            buffer->edges = NULL;
+            return NULL;
+        }
+        buffer->edges = newEdges;
+        buffer->capacity *= 2;
     }
-    printf("----------------\n");
+    return buffer->edges + (size_t)buffer->edgeSize * buffer->count++;
 }
 
-// 实现城市连接的增加功能
-void addConnection(GraphMatrix* graph, int startCity, int endCity, enum TransportMode mode, int cost, int time) {
-    if (startCity < 0 || startCity >= graph->size || endCity < 0 || endCity >= graph->size) {
-        printf("Invalid city index\n");
-        return;
+// 构建只含允许交通方式的紧凑邻接表，节点u的出边为edges[offsets[u]]到edges[offsets[u + 1] - 1]
+// 每种交通方式直接扫描对应矩阵的行，一次遍历完成，成功返回0
+int buildModeEdges(GraphMatrix* graph, int allowRoad, int allowRailway, int allowAir,
+                   enum SearchDimension dimension, int** offsets, ModeEdge** edges) {
+    int n = graph->size;
+    int allow[3] = { allowRoad, allowRailway, allowAir };
+    int** weight[3];
+    for (int m = ROAD; m <= AIR; m++) {
+        weight[m] = getWeightMatrix(graph, (enum TransportMode)m, dimension);
     }
     
-    switch (mode) {
-        case ROAD:
-            graph->graphRoad[startCity][endCity] = cost;
-            graph->graphRoad[endCity][startCity] = cost; // 无向图，双向添加
-            graph->timeRoad[startCity][endCity] = time;
-            graph->timeRoad[endCity][startCity] = time;
-            break;
-        case RAILWAY:
-            graph->graphRailway[startCity][endCity] = cost;
-            graph->graphRailway[endCity][startCity] = cost; // 无向图，双向添加
-            graph->timeRailway[startCity][endCity] = time;
-            graph->timeRailway[endCity][startCity] = time;
-            break;
-        case AIR:
-            graph->graphAir[startCity][endCity] = cost;
-            graph->graphAir[endCity][startCity] = cost; // 无向图，双向添加
-            graph->timeAir[startCity][endCity] = time;
-            graph->timeAir[endCity][startCity] = time;
-            break;
+    EdgeBuffer buffer;
+    if (initEdgeBuffer(&buffer, n, sizeof(ModeEdge)) != 0) {
+        return -1;
     }
     
-    printf("Connection added: %s to %s (%s), cost: %d yuan, time: %d hours\n", 
-           graph->city[startCity], graph->city[endCity], getTransportModeString(mode), cost, time);
+    for (int u = 0; u < n; u++) {
+        buffer.offsets[u] = buffer.count;
+        for (int m = ROAD; m <= AIR; m++) {
+            if (!allow[m]) {
+                continue;
+            }
+            const int* row = weight[m][u];
+            for (int v = 0; v < n; v++) {
+                if (row[v] == -1) {
+                    continue;
+                }
+                ModeEdge* edge = (ModeEdge*)appendEdge(&buffer);
+                if (!edge) {
+                    return -1;
+                }
+                edge->to = v;
+                edge->mode = (enum TransportMode)m;
+                edge->value = row[v];
+            }
+        }
+    }
+    buffer.offsets[n] = buffer.count;
+    *offsets = buffer.offsets;
+    *edges = (ModeEdge*)buffer.edges;
+    return 0;
 }
 
-// 实现城市连接的删除功能
-void removeConnection(GraphMatrix* graph, int startCity, int endCity, enum TransportMode mode) {
-    if (startCity < 0 || startCity >= graph->size || endCity < 0 || endCity >= graph->size) {
-        printf("Invalid city index\n");
-        return;
-    }
+// 在紧凑邻接表上用二叉堆做Dijkstra搜索；给出h时按 dist + h 出队（A*），h为-1的节点不扩展
+// end为-1时求出完整的最短路径树，否则终点出队即停止
+// blockedVex标记不可经过的节点，blockedEdge[v * 3 + mode]标记从start出发不可使用的边，均可为NULL
+// 调用前dist全为-1、visited全为0；本次改动过的节点记入touched，返回其个数，调用者据此只重置这些节点
+int searchModeEdges(const int* offsets, const ModeEdge* edges, int start, int end, const int* h,
+                    const int* blockedVex, const int* blockedEdge, int* dist, PreInfo* pre, int* visited, int* touched) {
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >, std::greater<std::pair<int, int> > > queue;
+    int touchedCount = 0;
     
-    switch (mode) {
-        case ROAD:
-            graph->graphRoad[startCity][endCity] = -1;
-            graph->graphRoad[endCity][startCity] = -1;
-            graph->timeRoad[startCity][endCity] = -1;
-            graph->timeRoad[endCity][startCity] = -1;
-            break;
-        case RAILWAY:
-            graph->graphRailway[startCity][endCity] = -1;
-            graph->graphRailway[endCity][startCity] = -1;
-            graph->timeRailway[startCity][endCity] = -1;
-            graph->timeRailway[endCity][startCity] = -1;
-            break;
-        case AIR:
-            graph->graphAir[startCity][endCity] = -1;
-            graph->graphAir[endCity][startCity] = -1;
-            graph->timeAir[startCity][endCity] = -1;
-            graph->timeAir[endCity][startCity] = -1;
+    dist[start] = 0;
+    pre[start].preVex = -1;
+    pre[start].transportMode = ROAD;
+    touched[touchedCount++] = start;
+    queue.push(std::make_pair(h ? h[start] : 0, start));
+    
+    while (!queue.empty()) {
+        int u = queue.top().second;
+        queue.pop();
+        if (visited[u]) {
+            continue;
+        }
+        visited[u] = 1;
+        if (u == end) {
             break;
+        }
+        
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = edges[e].to;
+            if (visited[v] || (blockedVex && blockedVex[v]) || (h && h[v] == -1)) {
+                continue;
+            }
+            if (u == start && blockedEdge && blockedEdge[v * 3 + edges[e].mode]) {
+                continue;
+            }
+            
+            int value = dist[u] + edges[e].value;
+            if (dist[v] == -1 || value < dist[v]) {
+                if (dist[v] == -1) {
+                    touched[touchedCount++] = v;
+                }
+                dist[v] = value;
+                pre[v].preVex = u;
+                pre[v].transportMode = edges[e].mode;
+                queue.push(std::make_pair(h ? value + h[v] : value, v));
+            }
+        }
     }
-    
-    printf("Connection removed: %s to %s (%s)\n", 
-           graph->city[startCity], graph->city[endCity], getTransportModeString(mode));
+    return touchedCount;
 }
 
-// 主函数
-int main() {
-    const char* filename = ".\\transport_data.txt";  // 使用相对路径
+// 判断两条路线是否完全相同（节点和交通方式均一致）
+int isSameRoute(RoutePath* a, RoutePath* b) {
+    if (a->length != b->length) {
+        return 0;
+    }
+    for (int i = 0; i < a->length; i++) {
+        if (a->vex[i] != b->vex[i] || (i > 0 && a->mode[i] != b->mode[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Yen算法求解前k条无环最短路线，返回实际找到的路线数，内存不足时返回-1
+// 允许的交通方式先合并成紧凑邻接表，之后的搜索都只访问真实存在的边；
+// 以终点为根的反向最短路径树只计算一次：第一条路线直接沿树得到，
+// 偏离点若沿树到终点的路径未被封锁则直接复用，否则以树距离为启发值做A*搜索，
+// 每次搜索只重置实际访问过的节点；根路径的代价由上一条路线的前缀和得到，
+// 偏离点只从上一条路线的偏离位置开始枚举
+int kShortestPaths(GraphMatrix* graph, int start, int end, int k, RoutePath* paths,
+                   int allowRoad, int allowRailway, int allowAir, enum SearchDimension dimension) {
+    int n = graph->size;
+    if (k <= 0 || start == end || !isConnected(graph, start, end, allowRoad, allowRailway, allowAir)) {
+        return 0;
+    }
     
-    printf("Loading transport data from file...\n");
-    GraphMatrix* graph = readTransportData(filename);
+    int* h = (int*)malloc(n * sizeof(int));
+    PreInfo* tree = (PreInfo*)malloc(n * sizeof(PreInfo));
+    int* g = (int*)malloc(n * sizeof(int));
+    PreInfo* pre = (PreInfo*)malloc(n * sizeof(PreInfo));
+    int* visited = (int*)malloc(n * sizeof(int));
+    int* blockedVex = (int*)calloc(n, sizeof(int));
+    int* blockedEdge = (int*)calloc(n * 3, sizeof(int));
+    int* prefix = (int*)malloc(n * sizeof(int));
+    int* spurVex = (int*)malloc(n * sizeof(int));
+    enum TransportMode* spurMode = (enum TransportMode*)malloc(n * sizeof(enum TransportMode));
+    int* touched = (int*)malloc(n * sizeof(int));
+    int* offsets = NULL;
+    ModeEdge* edges = NULL;
+    RoutePath* candidates = NULL;
+    int candidateCount = 0;
+    int found = 0;
     
-    if (!graph) {
-        printf("Failed to load transport data. Exiting...\n");
-        return 1;
+    if (!h || !tree || !g || !pre || !visited || !blockedVex || !blockedEdge || !prefix || !spurVex || !spurMode ||
+        !touched || buildModeEdges(graph, allowRoad, allowRailway, allowAir, dimension, &offsets, &edges) != 0) {
+        found = -1;
+        goto cleanup;
     }
     
-    printf("Successfully loaded data. %d cities in the graph.\n", graph->size);
+    for (int i = 0; i < n; i++) {
+        h[i] = -1;
+        g[i] = -1;
+        visited[i] = 0;
+    }
     
-    while (1) {
-        printf("\n===== City Transport System =====\n");
-        showCities(graph);
-        
-        printf("\nPlease choose an option:\n");
-        printf("1. Find the shortest path\n");
-        printf("2. Add a city connection\n");
-        printf("3. Remove a city connection\n");
-        printf("4. Exit\n");
+    // 反向最短路径树：tree[v].preVex为v沿最短路径走向终点的下一个节点
+    {
+        int touchedCount = searchModeEdges(offsets, edges, end, -1, NULL, NULL, NULL, h, tree, visited, touched);
+        for (int t = 0; t < touchedCount; t++) {
+            visited[touched[t]] = 0;
+        }
+    }
+    if (h[start] == -1) {
+        goto cleanup;
+    }
+    
+    // 第一条路线直接沿反向最短路径树得到
+    {
+        int length = 1;
+        for (int v = start; v != end; v = tree[v].preVex) {
+            length++;
+        }
+        paths[0].length = length;
+        paths[0].vex = (int*)malloc(length * sizeof(int));
+        paths[0].mode = (enum TransportMode*)malloc(length * sizeof(enum TransportMode));
+        if (!paths[0].vex || !paths[0].mode) {
+            freeRoutePath(&paths[0]);
+            found = -1;
+            goto cleanup;
+        }
+        paths[0].total = h[start];
+        paths[0].deviation = 0;
+        int v = start;
+        paths[0].vex[0] = start;
+        paths[0].mode[0] = ROAD;
+        for (int i = 1; i < length; i++) {
+            paths[0].vex[i] = tree[v].preVex;
+            paths[0].mode[i] = tree[v].transportMode;
+            v = tree[v].preVex;
+        }
+        found = 1;
+    }
+    
+    while (found < k) {
+        RoutePath* last = &paths[found - 1];
         
-        int choice;
-        printf("Your choice: ");
-        scanf("%d", &choice);
+        // 上一条路线的前缀代价
+        prefix[0] = 0;
+        for (int i = 1; i < last->length; i++) {
+            prefix[i] = prefix[i - 1] + getEdgeWeight(graph, last->vex[i - 1], last->vex[i], last->mode[i], dimension);
+        }
+        for (int i = 0; i < last->deviation; i++) {
+            blockedVex[last->vex[i]] = 1;
+        }
         
-        if (choice == 4) {
-            break;
-        } else if (choice == 1) {
-            char startCity[50], endCity[50];
-            printf("\nEnter departure city: ");
-            scanf("%s", startCity);
-            printf("Enter destination city: ");
-            scanf("%s", endCity);
-            
-            // 查找城市索引
-            int startIndex = findCityIndex(graph, startCity);
-            int endIndex = findCityIndex(graph, endCity);
-            
-            if (startIndex == -1) {
-                printf("Error: Departure city '%s' not found.\n", startCity);
-                continue;
-            }
+        for (int i = last->deviation; i < last->length - 1; i++) {
+            int spur = last->vex[i];
             
-            if (endIndex == -1) {
-                printf("Error: Destination city '%s' not found.\n", endCity);
-                continue;
+            // 封锁与当前根路径相同的已选路线在偏离点处使用的边
+            for (int p = 0; p < found; p++) {
+                RoutePath* route = &paths[p];
+                if (route->length <= i + 1) {
+                    continue;
+                }
+                int sameRoot = 1;
+                for (int j = 1; j <= i && sameRoot; j++) {
+                    if (route->vex[j] != last->vex[j] || route->mode[j] != last->mode[j]) {
+                        sameRoot = 0;
+                    }
+                }
+                if (sameRoot) {
+                    blockedEdge[route->vex[i + 1] * 3 + route->mode[i + 1]] = 1;
+                }
             }
             
-            if (startIndex == endIndex) {
-                printf("Departure and destination cities are the same.\n");
-                continue;
+            // 偏离点沿反向最短路径树到终点的路径未被封锁时直接复用
+            int spurLength = 0;
+            int spurCost = -1;
+            int reusable = (h[spur] != -1) && !blockedEdge[tree[spur].preVex * 3 + tree[spur].transportMode];
+            for (int v = tree[spur].preVex; reusable && v != -1; v = tree[v].preVex) {
+                if (blockedVex[v]) {
+                    reusable = 0;
+                }
             }
             
-            // 选择搜索维度
-            int dimensionChoice;
-            printf("\nPlease choose search dimension:\n");
-            printf("1. By cost (yuan)\n");
-            printf("2. By time (hours)\n");
-            printf("Your choice: ");
-            scanf("%d", &dimensionChoice);
-            
-            enum SearchDimension dimension = (dimensionChoice == 2) ? BY_TIME : BY_COST;
-            
-            // 选择交通方式
-            printf("\nPlease select transportation modes (enter the corresponding numbers, separated by spaces):\n");
-            printf("1. Road\n");
-            printf("2. Railway\n");
-            printf("3. Air\n");
-            printf("For example, enter '1 2' to use road and railway only\n");
-            
-            int allowRoad = 0, allowRailway = 0, allowAir = 0;
-            int modeInput;
-            char c;
-            
-            // 读取用户选择的交通方式
-            while ((c = getchar()) != '\n' && c != EOF); // 清空输入缓冲区
-            printf("Your choices: ");
-            
-            while (scanf("%d", &modeInput) == 1) {
-                switch (modeInput) {
-                    case 1:
-                        allowRoad = 1;
-                        break;
-                    case 2:
-                        allowRailway = 1;
-                        break;
-                    case 3:
-                        allowAir = 1;
-                        break;
-                    default:
-                        printf("Invalid mode choice: %d\n", modeInput);
+            if (reusable) {
+                spurCost = h[spur];
+                for (int v = spur; v != end; v = tree[v].preVex) {
+                    spurVex[spurLength] = tree[v].preVex;
+                    spurMode[spurLength] = tree[v].transportMode;
+                    spurLength++;
+                }
+            } else {
+                int touchedCount = searchModeEdges(offsets, edges, spur, end, h, blockedVex, blockedEdge,
+                                                   g, pre, visited, touched);
+                spurCost = g[end];
+                if (spurCost != -1) {
+                    for (int v = end; v != spur; v = pre[v].preVex) {
+                        spurLength++;
+                    }
+                    int pos = spurLength - 1;
+                    for (int v = end; v != spur; v = pre[v].preVex) {
+                        spurVex[pos] = v;
+                        spurMode[pos] = pre[v].transportMode;
+                        pos--;
+                    }
                 }
                 
-                // 检查是否还有更多输入
-                if ((c = getchar()) == '\n') break;
-                // 跳过空格
-                if (c != ' ') {
-                    ungetc(c, stdin);
+                // 只重置本次搜索访问过的节点
+                for (int t = 0; t < touchedCount; t++) {
+                    g[touched[t]] = -1;
+                    visited[touched[t]] = 0;
                 }
             }
             
-            // 如果用户没有选择任何交通方式，默认使用所有方式
-            if (!allowRoad && !allowRailway && !allowAir) {
-                printf("No transportation modes selected. Using all modes.\n");
-                allowRoad = allowRailway = allowAir = 1;
+            // 清除本轮偏离点的边封锁，并把偏离点加入下一轮的根路径
+            for (int p = 0; p < found; p++) {
+                if (paths[p].length > i + 1) {
+                    blockedEdge[paths[p].vex[i + 1] * 3 + paths[p].mode[i + 1]] = 0;
+                }
             }
+            blockedVex[spur] = 1;
             
-            // 显示用户选择的交通方式
-            printf("\nSelected transportation modes:");
-            if (allowRoad) printf(" Road");
-            if (allowRailway) printf(" Railway");
-            if (allowAir) printf(" Air");
-            printf("\n");
-            
-            // 分配内存
-            int* dist = (int*)malloc(graph->size * sizeof(int));
-            PreInfo* pre = (PreInfo*)malloc(graph->size * sizeof(PreInfo));
-            
-            if (!dist || !pre) {
-                printf("Error: Memory allocation failed.\n");
-                free(dist);
-                free(pre);
+            if (spurCost == -1) {
                 continue;
             }
             
-            // 计算最短路径
-            dijkstra(graph, startIndex, dist, pre, allowRoad, allowRailway, allowAir, dimension);
+            // 根路径 + 偏离路径组成候选路线
+            RoutePath candidate;
+            candidate.length = i + 1 + spurLength;
+            candidate.vex = (int*)malloc(candidate.length * sizeof(int));
+            candidate.mode = (enum TransportMode*)malloc(candidate.length * sizeof(enum TransportMode));
+            if (!candidate.vex || !candidate.mode) {
+                freeRoutePath(&candidate);
+                continue;
+            }
+            candidate.total = prefix[i] + spurCost;
+            candidate.deviation = i;
+            for (int j = 0; j <= i; j++) {
+                candidate.vex[j] = last->vex[j];
+                candidate.mode[j] = last->mode[j];
+            }
+            for (int j = 0; j < spurLength; j++) {
+                candidate.vex[i + 1 + j] = spurVex[j];
+                candidate.mode[i + 1 + j] = spurMode[j];
+            }
             
-            // 输出路径
-            printPath(graph, startIndex, endIndex, dist, pre, dimension);
+            int duplicate = 0;
+            for (int c = 0; c < candidateCount && !duplicate; c++) {
+                duplicate = isSameRoute(&candidates[c], &candidate);
+            }
+            if (duplicate) {
+                freeRoutePath(&candidate);
+                continue;
+            }
             
-            // 释放内存
-            free(dist);
-            free(pre);
-        } else if (choice == 2) {
-            // 添加城市连接
-            char startCity[50], endCity[50];
-            int modeChoice, cost, time;
+            RoutePath* newCandidates = (RoutePath*)realloc(candidates, (candidateCount + 1) * sizeof(RoutePath));
+            if (!newCandidates) {
+                freeRoutePath(&candidate);
+                continue;
+            }
+            candidates = newCandidates;
+            candidates[candidateCount++] = candidate;
+        }
+        
+        for (int i = 0; i < last->length; i++) {
+            blockedVex[last->vex[i]] = 0;
+        }
+        
+        if (candidateCount == 0) {
+            break; // 没有更多备选路线
+        }
+        
+        // 取出代价最小的候选路线
+        int best = 0;
+        for (int c = 1; c < candidateCount; c++) {
+            if (candidates[c].total < candidates[best].total) {
+                best = c;
+            }
+        }
+        paths[found++] = candidates[best];
+        candidates[best] = candidates[--candidateCount];
+    }
+    
+cleanup:
+    for (int c = 0; c < candidateCount; c++) {
+        freeRoutePath(&candidates[c]);
+    }
+    free(candidates);
+    free(h);
+    free(tree);
+    free(g);
+    free(pre);
+    free(visited);
+    free(blockedVex);
+    free(blockedEdge);
+    free(prefix);
+    free(spurVex);
+    free(spurMode);
+    free(touched);
+    free(offsets);
+    free(edges);
+    return found;
+}
+
+// 输出一条备选路线
+void printRoutePath(GraphMatrix* graph, RoutePath* path, int rank, enum SearchDimension dimension) {
+    if (dimension == BY_COST) {
+        printf("\nRoute %d, total cost: %d yuan\n", rank, path->total);
+    } else {
+        printf("\nRoute %d, total time: %d hours\n", rank, path->total);
+    }
+    
+    printf("%s", graph->city[path->vex[0]]);
+    for (int i = 1; i < path->length; i++) {
+        printf(" -> %s (%s)", graph->city[path->vex[i]], getTransportModeString(path->mode[i]));
+    }
+    printf("\n");
+}
+
+// 释放路线占用的内存
+void freeRoutePath(RoutePath* path) {
+    free(path->vex);
+    free(path->mode);
+    path->vex = NULL;
+    path->mode = NULL;
+    path->length = 0;
+}
+
+// 按允许的交通方式合并三种交通方式的边，构建紧凑邻接表：每对相邻城市只保留一条边，
+// 权值为所有允许交通方式中的最小值，mode为对应的交通方式；成功返回0
+int buildMergedEdges(GraphMatrix* graph, int allowRoad, int allowRailway, int allowAir,
+                     enum SearchDimension dimension, int** offsets, ModeEdge** edges) {
+    int n = graph->size;
+    int allow[3] = { allowRoad, allowRailway, allowAir };
+    int** weight[3];
+    for (int m = ROAD; m <= AIR; m++) {
+        weight[m] = getWeightMatrix(graph, (enum TransportMode)m, dimension);
+    }
+    
+    EdgeBuffer buffer;
+    if (initEdgeBuffer(&buffer, n, sizeof(ModeEdge)) != 0) {
+        return -1;
+    }
+    
+    for (int u = 0; u < n; u++) {
+        buffer.offsets[u] = buffer.count;
+        for (int v = 0; v < n; v++) {
+            int best = -1;
+            enum TransportMode bestMode = ROAD;
+            for (int m = ROAD; m <= AIR; m++) {
+                if (allow[m] && weight[m][u][v] != -1 && (best == -1 || weight[m][u][v] < best)) {
+                    best = weight[m][u][v];
+                    bestMode = (enum TransportMode)m;
+                }
+            }
+            if (best == -1) {
+                continue;
+            }
+            ModeEdge* edge = (ModeEdge*)appendEdge(&buffer);
+            if (!edge) {
+                return -1;
+            }
+            edge->to = v;
+            edge->mode = bestMode;
+            edge->value = best;
+        }
+    }
+    buffer.offsets[n] = buffer.count;
+    *offsets = buffer.offsets;
+    *edges = (ModeEdge*)buffer.edges;
+    return 0;
+}
+
+// 批量多源搜索：同时求出一组（最多MATRIX_BLOCK个）出发城市到所有城市的最短距离
+// dist[v * blockCount + b]为第b个出发城市到v的距离，不可达时为MATRIX_INFINITY
+// 每个节点用位掩码记录距离被改进、尚未向外松弛的出发城市；节点出队时只扫描一次它的邻接表，
+// 对所有待松弛的出发城市同时松弛。出队顺序按待松弛距离的最小值，节点可能多次出队（标签修正），
+// 结果与逐个出发城市做Dijkstra相同
+// need[v]标记哪些出发城市需要v的距离（needCount为标记总数）。出队键值单调不减，
+// 需要的距离不超过当前键值时即已确定；尚未确定的按其中最小距离把v重新入队，
+// pending[v]为这样入队的键值。所有需要的距离都确定后提前结束，不必搜完整个连通分量；
+// 函数返回时need被清零
+void searchSourceBlock(int n, const int* offsets, const ModeEdge* edges, const int* block, int blockCount,
+                       unsigned long long* need, int needCount, int* dist, unsigned long long* dirty, int* pending) {
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >, std::greater<std::pair<int, int> > > queue;
+    
+    for (int i = 0; i < n * blockCount; i++) {
+        dist[i] = MATRIX_INFINITY;
+    }
+    for (int i = 0; i < n; i++) {
+        dirty[i] = 0;
+        pending[i] = MATRIX_INFINITY;
+    }
+    for (int b = 0; b < blockCount; b++) {
+        dist[block[b] * blockCount + b] = 0;
+        dirty[block[b]] |= 1ULL << b;
+        queue.push(std::make_pair(0, block[b]));
+    }
+    
+    while (!queue.empty() && needCount > 0) {
+        int key = queue.top().first;
+        int u = queue.top().second;
+        queue.pop();
+        
+        // 距离不超过当前键值的需要项已经确定
+        if (need[u]) {
+            const int* du = dist + u * blockCount;
+            int nextKey = MATRIX_INFINITY;
+            for (unsigned long long rest = need[u]; rest; rest &= rest - 1) {
+                int b = __builtin_ctzll(rest);
+                if (du[b] <= key) {
+                    need[u] &= ~(1ULL << b);
+                    needCount--;
+                } else if (du[b] < nextKey) {
+                    nextKey = du[b];
+                }
+            }
+            // 每个节点最多保留一个这样的队列项
+            if (nextKey != MATRIX_INFINITY && (pending[u] <= key || nextKey < pending[u])) {
+                pending[u] = nextKey;
+                queue.push(std::make_pair(nextKey, u));
+            }
+        }
+        
+        // 跳过过期的队列项：节点已松弛完毕，或者还有更小键值的项在队列中
+        unsigned long long lanes = dirty[u];
+        if (!lanes) {
+            continue;
+        }
+        const int* du = dist + u * blockCount;
+        int minKey = MATRIX_INFINITY;
+        for (unsigned long long rest = lanes; rest; rest &= rest - 1) {
+            int b = __builtin_ctzll(rest);
+            if (du[b] < minKey) {
+                minKey = du[b];
+            }
+        }
+        if (key > minKey) {
+            continue;
+        }
+        dirty[u] = 0;
+        
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = edges[e].to;
+            int w = edges[e].value;
+            int* dv = dist + v * blockCount;
+            int pushKey = MATRIX_INFINITY;
+            for (unsigned long long rest = lanes; rest; rest &= rest - 1) {
+                int b = __builtin_ctzll(rest);
+                int value = du[b] + w;
+                if (value < dv[b]) {
+                    dv[b] = value;
+                    dirty[v] |= 1ULL << b;
+                    if (value < pushKey) {
+                        pushKey = value;
+                    }
+                }
+            }
+            if (pushKey != MATRIX_INFINITY) {
+                queue.push(std::make_pair(pushKey, v));
+            }
+        }
+    }
+    
+    for (int i = 0; i < n; i++) {
+        need[i] = 0;
+    }
+}
+
+// 多对多距离矩阵查询，结果按行写入调用者提供的连续缓冲区：
+// result[i * targetCount + j]为sources[i]到targets[j]的最短距离，不可达时为-1
+// 合并后的紧凑邻接表只构建一次；图是无向的，因此从城市较少的一侧出发。
+// 去重后的出发城市按编号排序（重排后编号相近的城市在图中也相近，搜索波前重叠更多），
+// 每MATRIX_BLOCK个一组做批量搜索；与所有目的城市都不连通的出发城市不参与搜索。
+// 每组只等待与组内出发城市连通的目的城市，它们的距离都确定后即停止搜索；
+// 最坏情况下（目的城市离得很远）仍会扫描整个连通分量
+// 成功返回0，参数无效或内存不足返回-1
+int distanceMatrix(GraphMatrix* graph, const int* sources, int sourceCount, const int* targets, int targetCount,
+                   int allowRoad, int allowRailway, int allowAir, enum SearchDimension dimension, int* result) {
+    int n = graph->size;
+    if (sourceCount <= 0 || targetCount <= 0) {
+        return 0;
+    }
+    for (int i = 0; i < sourceCount; i++) {
+        if (sources[i] < 0 || sources[i] >= n) {
+            return -1;
+        }
+    }
+    for (int j = 0; j < targetCount; j++) {
+        if (targets[j] < 0 || targets[j] >= n) {
+            return -1;
+        }
+    }
+    
+    // 从较少的一侧出发，结果转置写回
+    int transposed = targetCount < sourceCount;
+    const int* from = transposed ? targets : sources;
+    const int* to = transposed ? sources : targets;
+    int fromCount = transposed ? targetCount : sourceCount;
+    int toCount = transposed ? sourceCount : targetCount;
+    
+    int* offsets = NULL;
+    ModeEdge* edges = NULL;
+    int* dist = NULL;
+    unsigned long long* dirty = (unsigned long long*)malloc(n * sizeof(unsigned long long));
+    unsigned long long* need = (unsigned long long*)calloc(n, sizeof(unsigned long long));
+    int* pending = (int*)malloc(n * sizeof(int));
+    int* lane = (int*)malloc(n * sizeof(int));       // 出发城市在当前批次中的位置，-1表示不在本批
+    int* order = (int*)malloc(n * sizeof(int));      // 去重并排序后需要搜索的出发城市
+    
+    if (!dirty || !need || !pending || !lane || !order ||
+        buildMergedEdges(graph, allowRoad, allowRailway, allowAir, dimension, &offsets, &edges) != 0) {
+        free(dirty);
+        free(need);
+        free(pending);
+        free(lane);
+        free(order);
+        return -1;
+    }
+    
+    // 按编号顺序收集需要搜索的出发城市，不需要搜索的行直接填-1
+    for (int i = 0; i < n; i++) {
+        lane[i] = 0;
+    }
+    for (int i = 0; i < fromCount; i++) {
+        lane[from[i]] = 1;
+    }
+    int orderCount = 0;
+    for (int s = 0; s < n; s++) {
+        if (!lane[s]) {
+            continue;
+        }
+        int connected = 0;
+        for (int j = 0; j < toCount && !connected; j++) {
+            connected = isConnected(graph, s, to[j], allowRoad, allowRailway, allowAir);
+        }
+        if (connected) {
+            order[orderCount++] = s;
+        }
+    }
+    
+    // 出发城市不足MATRIX_BLOCK个时按实际数量分配
+    int laneCount = (orderCount < MATRIX_BLOCK) ? orderCount : MATRIX_BLOCK;
+    if (laneCount > 0) {
+        dist = (int*)malloc((size_t)n * laneCount * sizeof(int));
+        if (!dist) {
+            free(offsets);
+            free(edges);
+            free(dirty);
+            free(need);
+            free(pending);
+            free(lane);
+            free(order);
+            return -1;
+        }
+    }
+    
+    for (int i = 0; i < n; i++) {
+        lane[i] = -1;
+    }
+    for (int i = 0; i < fromCount; i++) {
+        for (int j = 0; j < toCount; j++) {
+            if (transposed) {
+                result[j * targetCount + i] = -1;
+            } else {
+                result[i * targetCount + j] = -1;
+            }
+        }
+    }
+    
+    for (int first = 0; first < orderCount; first += MATRIX_BLOCK) {
+        int blockCount = (orderCount - first < MATRIX_BLOCK) ? orderCount - first : MATRIX_BLOCK;
+        const int* block = order + first;
+        int needCount = 0;
+        for (int b = 0; b < blockCount; b++) {
+            lane[block[b]] = b;
+            for (int j = 0; j < toCount; j++) {
+                int t = to[j];
+                if (!((need[t] >> b) & 1) && isConnected(graph, block[b], t, allowRoad, allowRailway, allowAir)) {
+                    need[t] |= 1ULL << b;
+                    needCount++;
+                }
+            }
+        }
+        
+        searchSourceBlock(n, offsets, edges, block, blockCount, need, needCount, dist, dirty, pending);
+        
+        for (int i = 0; i < fromCount; i++) {
+            int b = lane[from[i]];
+            if (b == -1) {
+                continue;
+            }
+            for (int j = 0; j < toCount; j++) {
+                int value = dist[to[j] * blockCount + b];
+                if (value == MATRIX_INFINITY) {
+                    value = -1;
+                }
+                if (transposed) {
+                    result[j * targetCount + i] = value;
+                } else {
+                    result[i * targetCount + j] = value;
+                }
+            }
+        }
+        
+        for (int b = 0; b < blockCount; b++) {
+            lane[block[b]] = -1;
+        }
+    }
+    
+    free(offsets);
+    free(edges);
+    free(dist);
+    free(dirty);
+    free(need);
+    free(pending);
+    free(lane);
+    free(order);
+    return 0;
+}
+
+// 构建预算查询使用的紧凑邻接表：只保留允许的交通方式，每条边同时记录两个维度的权值
+// 节点u的出边为edges[offsets[u]]到edges[offsets[u + 1] - 1]；直接扫描各矩阵的行，一次遍历完成，成功返回0
+int buildBudgetEdges(GraphMatrix* graph, int allowRoad, int allowRailway, int allowAir,
+                     enum SearchDimension dimension, int** offsets, BudgetEdge** edges) {
+    int n = graph->size;
+    int allow[3] = { allowRoad, allowRailway, allowAir };
+    enum SearchDimension otherDimension = (dimension == BY_COST) ? BY_TIME : BY_COST;
+    
+    EdgeBuffer buffer;
+    if (initEdgeBuffer(&buffer, n, sizeof(BudgetEdge)) != 0) {
+        return -1;
+    }
+    
+    for (int u = 0; u < n; u++) {
+        buffer.offsets[u] = buffer.count;
+        for (int m = ROAD; m <= AIR; m++) {
+            if (!allow[m]) {
+                continue;
+            }
+            const int* valueRow = getWeightMatrix(graph, (enum TransportMode)m, dimension)[u];
+            const int* otherRow = getWeightMatrix(graph, (enum TransportMode)m, otherDimension)[u];
+            for (int v = 0; v < n; v++) {
+                if (valueRow[v] == -1) {
+                    continue;
+                }
+                BudgetEdge* edge = (BudgetEdge*)appendEdge(&buffer);
+                if (!edge) {
+                    return -1;
+                }
+                edge->to = v;
+                edge->mode = (enum TransportMode)m;
+                edge->value = valueRow[v];
+                edge->other = otherRow[v];
+            }
+        }
+    }
+    buffer.offsets[n] = buffer.count;
+    *offsets = buffer.offsets;
+    *edges = (BudgetEdge*)buffer.edges;
+    return 0;
+}
+
+// 预算搜索的标签，按主维度从小到大出队，相同时副维度小的优先
+typedef struct BudgetLabel {
+    int value;
+    int other;
+    int vex;
+    PreInfo pre;
+} BudgetLabel;
+
+struct BudgetLabelGreater {
+    bool operator()(const BudgetLabel& a, const BudgetLabel& b) const {
+        return (a.value != b.value) ? (a.value > b.value) : (a.other > b.other);
+    }
+};
+
+typedef std::priority_queue<BudgetLabel, std::vector<BudgetLabel>, BudgetLabelGreater> BudgetQueue;
+
+// 沿一条边扩展标签：超出预算或被目标节点上已确定的标签支配时剪枝，否则入队
+void relaxBudgetLabel(BudgetQueue& queue, const BudgetLabel& label, int v, enum TransportMode mode, int value, int other,
+                      int budget, int otherBudget, const int* minOther, const int* reached) {
+    value += label.value;
+    other += label.other;
+    
+    if (value > budget || (otherBudget != -1 && other > otherBudget)) {
+        return;
+    }
+    if (reached[v] && (otherBudget == -1 || other >= minOther[v])) {
+        return;
+    }
+    
+    BudgetLabel next;
+    next.value = value;
+    next.other = other;
+    next.vex = v;
+    next.pre.preVex = label.vex;
+    next.pre.transportMode = mode;
+    queue.push(next);
+}
+
+// 做一次预算受限搜索，返回可达城市个数
+// 给出紧凑邻接表（offsets非NULL）时沿表扩展，否则直接扫描已确定节点在各允许交通方式矩阵中的行，
+// 单次查询只需O(确定的节点数 * n)，不必先构建整张邻接表
+// 超出预算的标签直接剪枝，不会进入队列；标签按主维度顺序确定，
+// 因此同一节点上后出队的标签只有副维度更小时才不被支配（无副约束时每个节点只保留第一个标签）
+// minOther和reached为长度为n的临时数组
+int searchWithinBudget(GraphMatrix* graph, const int* allow, enum SearchDimension dimension,
+                       const int* offsets, const BudgetEdge* edges, int start, int budget, int otherBudget,
+                       ReachInfo* result, int* minOther, int* reached) {
+    int n = graph->size;
+    enum SearchDimension otherDimension = (dimension == BY_COST) ? BY_TIME : BY_COST;
+    BudgetQueue queue;
+    int count = 0;
+    
+    for (int i = 0; i < n; i++) {
+        reached[i] = 0;
+        minOther[i] = -1;
+    }
+    
+    BudgetLabel first;
+    first.value = 0;
+    first.other = 0;
+    first.vex = start;
+    first.pre.preVex = -1;
+    first.pre.transportMode = ROAD;
+    queue.push(first);
+    
+    while (!queue.empty()) {
+        BudgetLabel label = queue.top();
+        queue.pop();
+        int u = label.vex;
+        
+        // 被同一节点上已确定的标签支配
+        if (reached[u] && (otherBudget == -1 || label.other >= minOther[u])) {
+            continue;
+        }
+        
+        if (!reached[u]) {
+            reached[u] = 1;
+            result[count].city = u;
+            result[count].value = label.value;
+            result[count].other = label.other;
+            result[count].pre = label.pre;
+            count++;
+        }
+        minOther[u] = label.other;
+        
+        if (offsets) {
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                relaxBudgetLabel(queue, label, edges[e].to, edges[e].mode, edges[e].value, edges[e].other,
+                                 budget, otherBudget, minOther, reached);
+            }
+        } else {
+            for (int m = ROAD; m <= AIR; m++) {
+                if (!allow[m]) {
+                    continue;
+                }
+                const int* valueRow = getWeightMatrix(graph, (enum TransportMode)m, dimension)[u];
+                const int* otherRow = getWeightMatrix(graph, (enum TransportMode)m, otherDimension)[u];
+                for (int v = 0; v < n; v++) {
+                    if (valueRow[v] != -1) {
+                        relaxBudgetLabel(queue, label, v, (enum TransportMode)m, valueRow[v], otherRow[v],
+                                         budget, otherBudget, minOther, reached);
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+// 批量预算可达查询：对每个出发城市求出在主维度预算budget内可达的城市
+// otherBudget为另一维度的预算，-1表示不限制
+// 第i个出发城市的结果写入results[i * graph->size]开始的位置，个数写入counts[i]，按主维度从小到大排列
+// 多个出发城市时紧凑邻接表只构建一次，构建代价由所有出发城市分摊；成功返回0
+int reachableWithinBudgetBatch(GraphMatrix* graph, const int* origins, int originCount, enum SearchDimension dimension,
+                               int budget, int otherBudget, int allowRoad, int allowRailway, int allowAir,
+                               ReachInfo* results, int* counts) {
+    int n = graph->size;
+    int allow[3] = { allowRoad, allowRailway, allowAir };
+    for (int i = 0; i < originCount; i++) {
+        if (origins[i] < 0 || origins[i] >= n) {
+            return -1;
+        }
+    }
+    
+    int* offsets = NULL;
+    BudgetEdge* edges = NULL;
+    int* minOther = (int*)malloc(n * sizeof(int));
+    int* reached = (int*)malloc(n * sizeof(int));
+    
+    if (!minOther || !reached || (originCount > 1 &&
+        buildBudgetEdges(graph, allowRoad, allowRailway, allowAir, dimension, &offsets, &edges) != 0)) {
+        free(minOther);
+        free(reached);
+        return -1;
+    }
+    
+    for (int i = 0; i < originCount; i++) {
+        counts[i] = searchWithinBudget(graph, allow, dimension, offsets, edges, origins[i], budget, otherBudget,
+                                       results + (size_t)i * n, minOther, reached);
+    }
+    
+    free(offsets);
+    free(edges);
+    free(minOther);
+    free(reached);
+    return 0;
+}
+
+// 单个出发城市的预算可达查询，result至少能容纳graph->size个元素，返回可达城市个数，出错返回-1
+// 直接在邻接矩阵上搜索，代价只与预算内确定的城市数有关
+int reachableWithinBudget(GraphMatrix* graph, int start, enum SearchDimension dimension, int budget, int otherBudget,
+                          int allowRoad, int allowRailway, int allowAir, ReachInfo* result) {
+    int count;
+    if (reachableWithinBudgetBatch(graph, &start, 1, dimension, budget, otherBudget,
+                                   allowRoad, allowRailway, allowAir, result, &count) != 0) {
+        return -1;
+    }
+    return count;
+}
+
+// 由允许的交通方式得到掩码（1到7），掩码减一即连通分量数组的下标
+int getModeMask(int allowRoad, int allowRailway, int allowAir) {
+    return (allowRoad ? 1 : 0) | (allowRailway ? 2 : 0) | (allowAir ? 4 : 0);
+}
+
+// 并查集查找（路径减半）
+int findComponent(int* parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// 并查集合并（按大小合并，小的分量挂到大的分量下）
+void unionComponents(int* parent, int* size, int a, int b) {
+    int rootA = findComponent(parent, a);
+    int rootB = findComponent(parent, b);
+    if (rootA == rootB) {
+        return;
+    }
+    if (size[rootA] < size[rootB]) {
+        int temp = rootA;
+        rootA = rootB;
+        rootB = temp;
+    }
+    parent[rootB] = rootA;
+    size[rootA] += size[rootB];
+}
+
+// 重建一组掩码下的连通分量，masks的第(掩码-1)位为1表示需要重建
+// 只对邻接矩阵上三角做一次扫描：每对城市先求出相连的交通方式位，再合并到所有包含这些位的掩码中
+void rebuildComponents(GraphMatrix* graph, int masks) {
+    int n = graph->size;
+    
+    for (int mask = 1; mask <= 7; mask++) {
+        if (!(masks & (1 << (mask - 1)))) {
+            continue;
+        }
+        if (n == 0) {
+            graph->componentDirty[mask - 1] = 0;
+            continue;
+        }
+        if (!graph->componentParent[mask - 1] || !graph->componentSize[mask - 1]) {
+            masks &= ~(1 << (mask - 1)); // 保持待重建状态，查询时退化为不拒绝
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            graph->componentParent[mask - 1][i] = i;
+            graph->componentSize[mask - 1][i] = 1;
+        }
+    }
+    if (n == 0 || masks == 0) {
+        return;
+    }
+    
+    for (int u = 0; u < n; u++) {
+        const int* road = graph->graphRoad[u];
+        const int* railway = graph->graphRailway[u];
+        const int* air = graph->graphAir[u];
+        for (int v = u + 1; v < n; v++) {
+            int bits = (road[v] != -1 ? 1 : 0) | (railway[v] != -1 ? 2 : 0) | (air[v] != -1 ? 4 : 0);
+            if (!bits) {
+                continue;
+            }
+            for (int mask = 1; mask <= 7; mask++) {
+                if ((mask & bits) && (masks & (1 << (mask - 1)))) {
+                    unionComponents(graph->componentParent[mask - 1], graph->componentSize[mask - 1], u, v);
+                }
+            }
+        }
+    }
+    
+    for (int mask = 1; mask <= 7; mask++) {
+        if (masks & (1 << (mask - 1))) {
+            graph->componentDirty[mask - 1] = 0;
+        }
+    }
+}
+
+// 构建全部7种交通方式组合下的连通分量
+void buildConnectivityIndex(GraphMatrix* graph) {
+    rebuildComponents(graph, 0x7f);
+}
+
+// 判断两个城市在允许的交通方式下是否连通，删除连接后的掩码在此惰性重建
+// 删除一条边会使包含该交通方式的4个掩码同时失效，它们在同一次扫描中一起重建
+// 返回0时两城市之间一定不存在路径，可以直接拒绝查询
+int isConnected(GraphMatrix* graph, int a, int b, int allowRoad, int allowRailway, int allowAir) {
+    int mask = getModeMask(allowRoad, allowRailway, allowAir);
+    if (mask == 0) {
+        return a == b;
+    }
+    
+    if (graph->componentDirty[mask - 1]) {
+        int dirtyMasks = 0;
+        for (int i = 0; i < 7; i++) {
+            if (graph->componentDirty[i]) {
+                dirtyMasks |= 1 << i;
+            }
+        }
+        rebuildComponents(graph, dirtyMasks);
+        if (graph->componentDirty[mask - 1]) {
+            return 1; // 重建失败时不做拒绝
+        }
+    }
+    
+    int* parent = graph->componentParent[mask - 1];
+    return findComponent(parent, a) == findComponent(parent, b);
+}
+
+// 按新顺序重排一个矩阵的行和列：新矩阵第i行第j列为原矩阵第order[i]行第order[j]列
+void permuteMatrix(int** matrix, int n, const int* order, int** rowBuffer, int* colBuffer) {
+    for (int i = 0; i < n; i++) {
+        rowBuffer[i] = matrix[order[i]];
+    }
+    for (int i = 0; i < n; i++) {
+        matrix[i] = rowBuffer[i];
+        for (int j = 0; j < n; j++) {
+            colBuffer[j] = matrix[i][order[j]];
+        }
+        memcpy(matrix[i], colBuffer, n * sizeof(int));
+    }
+}
+
+// 用逆Cuthill-McKee顺序重新编号城市，使相邻城市的编号尽量接近，
+// 搜索时扫描的矩阵行和距离数组的访问更集中；城市名称随编号一起重排，按名称查询不受影响
+// 成功返回0，内存不足时保持原顺序并返回-1
+int reorderGraph(GraphMatrix* graph) {
+    int n = graph->size;
+    if (n <= 1) {
+        return 0;
+    }
+    
+    int* degree = (int*)calloc(n, sizeof(int));
+    int* order = (int*)malloc(n * sizeof(int));   // order[新编号] = 原编号
+    int* placed = (int*)calloc(n, sizeof(int));
+    int** rowBuffer = (int**)malloc(n * sizeof(int*));
+    int* colBuffer = (int*)malloc(n * sizeof(int));
+    char** cityBuffer = (char**)malloc(n * sizeof(char*));
+    
+    if (!degree || !order || !placed || !rowBuffer || !colBuffer || !cityBuffer) {
+        free(degree);
+        free(order);
+        free(placed);
+        free(rowBuffer);
+        free(colBuffer);
+        free(cityBuffer);
+        return -1;
+    }
+    
+    // 任意一种交通方式相连即视为相邻
+    for (int u = 0; u < n; u++) {
+        for (int v = 0; v < n; v++) {
+            if (u != v && (graph->graphRoad[u][v] != -1 || graph->graphRailway[u][v] != -1 ||
+                           graph->graphAir[u][v] != -1)) {
+                degree[u]++;
+            }
+        }
+    }
+    
+    // Cuthill-McKee：每个连通分量从度最小的城市开始广度优先遍历，邻居按度从小到大入队
+    int count = 0;
+    while (count < n) {
+        int start = -1;
+        for (int i = 0; i < n; i++) {
+            if (!placed[i] && (start == -1 || degree[i] < degree[start])) {
+                start = i;
+            }
+        }
+        placed[start] = 1;
+        order[count++] = start;
+        
+        for (int head = count - 1; head < count; head++) {
+            int u = order[head];
+            int first = count;
+            for (int v = 0; v < n; v++) {
+                if (!placed[v] && (graph->graphRoad[u][v] != -1 || graph->graphRailway[u][v] != -1 ||
+                                   graph->graphAir[u][v] != -1)) {
+                    placed[v] = 1;
+                    // 插入排序，保持本批邻居按度递增
+                    int pos = count++;
+                    while (pos > first && degree[order[pos - 1]] > degree[v]) {
+                        order[pos] = order[pos - 1];
+                        pos--;
+                    }
+                    order[pos] = v;
+                }
+            }
+        }
+    }
+    
+    // 逆序得到逆Cuthill-McKee顺序
+    for (int i = 0; i < n / 2; i++) {
+        int temp = order[i];
+        order[i] = order[n - 1 - i];
+        order[n - 1 - i] = temp;
+    }
+    
+    // 重排城市名称
+    for (int i = 0; i < n; i++) {
+        cityBuffer[i] = graph->city[order[i]];
+    }
+    memcpy(graph->city, cityBuffer, n * sizeof(char*));
+    
+    // 重排全部邻接矩阵
+    permuteMatrix(graph->graphRoad, n, order, rowBuffer, colBuffer);
+    permuteMatrix(graph->graphRailway, n, order, rowBuffer, colBuffer);
+    permuteMatrix(graph->graphAir, n, order, rowBuffer, colBuffer);
+    permuteMatrix(graph->timeRoad, n, order, rowBuffer, colBuffer);
+    permuteMatrix(graph->timeRailway, n, order, rowBuffer, colBuffer);
+    permuteMatrix(graph->timeAir, n, order, rowBuffer, colBuffer);
+    
+    // 连通分量索引中的编号已失效，全部重建
+    buildConnectivityIndex(graph);
+    
+    free(degree);
+    free(order);
+    free(placed);
+    free(rowBuffer);
+    free(colBuffer);
+    free(cityBuffer);
+    return 0;
+}
+
+// 销毁图
+void destroyGraph(GraphMatrix* graph) {
+    if (!graph) {
+        return;
+    }
+    
+    // 释放城市名称数组
+    for (int i = 0; i < graph->size; i++) {
+        free(graph->city[i]);
+    }
+    free(graph->city);
+    
+    // 释放邻接矩阵
+    for (int i = 0; i < graph->size; i++) {
+        if (graph->graphRoad) free(graph->graphRoad[i]);
+        if (graph->graphRailway) free(graph->graphRailway[i]);
+        if (graph->graphAir) free(graph->graphAir[i]);
+        if (graph->timeRoad) free(graph->timeRoad[i]);
+        if (graph->timeRailway) free(graph->timeRailway[i]);
+        if (graph->timeAir) free(graph->timeAir[i]);
+    }
+    free(graph->graphRoad);
+    free(graph->graphRailway);
+    free(graph->graphAir);
+    free(graph->timeRoad);
+    free(graph->timeRailway);
+    free(graph->timeAir);
+    for (int i = 0; i < 7; i++) {
+        free(graph->componentParent[i]);
+        free(graph->componentSize[i]);
+    }
+    
+    free(graph);
+}
+
+// 显示所有城市
+void showCities(GraphMatrix* graph) {
+    printf("\nAvailable cities:\n");
+    printf("----------------\n");
+    for (int i = 0; i < graph->size; i++) {
+        printf("%d. %s\n", i + 1, graph->city[i]);
+    }
+    printf("----------------\n");
+}
+
+// 实现城市连接的增加功能
+void addConnection(GraphMatrix* graph, int startCity, int endCity, enum TransportMode mode, int cost, int time) {
+    if (startCity < 0 || startCity >= graph->size || endCity < 0 || endCity >= graph->size) {
+        printf("Invalid city index\n");
+        return;
+    }
+    
+    switch (mode) {
+        case ROAD:
+            graph->graphRoad[startCity][endCity] = cost;
+            graph->graphRoad[endCity][startCity] = cost; // 无向图，双向添加
+            graph->timeRoad[startCity][endCity] = time;
+            graph->timeRoad[endCity][startCity] = time;
+            break;
+        case RAILWAY:
+            graph->graphRailway[startCity][endCity] = cost;
+            graph->graphRailway[endCity][startCity] = cost; // 无向图，双向添加
+            graph->timeRailway[startCity][endCity] = time;
+            graph->timeRailway[endCity][startCity] = time;
+            break;
+        case AIR:
+            graph->graphAir[startCity][endCity] = cost;
+            graph->graphAir[endCity][startCity] = cost; // 无向图，双向添加
+            graph->timeAir[startCity][endCity] = time;
+            graph->timeAir[endCity][startCity] = time;
+            break;
+    }
+    
+    // 增量更新包含该交通方式的连通分量索引
+    for (int mask = 1; mask <= 7; mask++) {
+        if ((mask & (1 << mode)) && !graph->componentDirty[mask - 1]) {
+            unionComponents(graph->componentParent[mask - 1], graph->componentSize[mask - 1], startCity, endCity);
+        }
+    }
+    
+    printf("Connection added: %s to %s (%s), cost: %d yuan, time: %d hours\n", 
+           graph->city[startCity], graph->city[endCity], getTransportModeString(mode), cost, time);
+}
+
+// 实现城市连接的删除功能
+void removeConnection(GraphMatrix* graph, int startCity, int endCity, enum TransportMode mode) {
+    if (startCity < 0 || startCity >= graph->size || endCity < 0 || endCity >= graph->size) {
+        printf("Invalid city index\n");
+        return;
+    }
+    
+    switch (mode) {
+        case ROAD:
+            graph->graphRoad[startCity][endCity] = -1;
+            graph->graphRoad[endCity][startCity] = -1;
+            graph->timeRoad[startCity][endCity] = -1;
+            graph->timeRoad[endCity][startCity] = -1;
+            break;
+        case RAILWAY:
+            graph->graphRailway[startCity][endCity] = -1;
+            graph->graphRailway[endCity][startCity] = -1;
+            graph->timeRailway[startCity][endCity] = -1;
+            graph->timeRailway[endCity][startCity] = -1;
+            break;
+        case AIR:
+            graph->graphAir[startCity][endCity] = -1;
+            graph->graphAir[endCity][startCity] = -1;
+            graph->timeAir[startCity][endCity] = -1;
+            graph->timeAir[endCity][startCity] = -1;
+            break;
+    }
+    
+    // 删除边可能拆分连通分量，标记包含该交通方式的索引待重建
+    for (int mask = 1; mask <= 7; mask++) {
+        if (mask & (1 << mode)) {
+            graph->componentDirty[mask - 1] = 1;
+        }
+    }
+    
+    printf("Connection removed: %s to %s (%s)\n", 
+           graph->city[startCity], graph->city[endCity], getTransportModeString(mode));
+}
+
+// 读取用户选择的搜索维度
+enum SearchDimension readSearchDimension() {
+    int dimensionChoice;
+    printf("\nPlease choose search dimension:\n");
+    printf("1. By cost (yuan)\n");
+    printf("2. By time (hours)\n");
+    printf("Your choice: ");
+    scanf("%d", &dimensionChoice);
+    
+    return (dimensionChoice == 2) ? BY_TIME : BY_COST;
+}
+
+// 读取用户选择的交通方式
+void readTransportModes(int* allowRoad, int* allowRailway, int* allowAir) {
+    printf("\nPlease select transportation modes (enter the corresponding numbers, separated by spaces):\n");
+    printf("1. Road\n");
+    printf("2. Railway\n");
+    printf("3. Air\n");
+    printf("For example, enter '1 2' to use road and railway only\n");
+    
+    int modeInput;
+    char c;
+    *allowRoad = *allowRailway = *allowAir = 0;
+    
+    // 读取用户选择的交通方式
+    while ((c = getchar()) != '\n' && c != EOF); // 清空输入缓冲区
+    printf("Your choices: ");
+    
+    while (scanf("%d", &modeInput) == 1) {
+        switch (modeInput) {
+            case 1:
+                *allowRoad = 1;
+                break;
+            case 2:
+                *allowRailway = 1;
+                break;
+            case 3:
+                *allowAir = 1;
+                break;
+            default:
+                printf("Invalid mode choice: %d\n", modeInput);
+        }
+        
+        // 检查是否还有更多输入
+        if ((c = getchar()) == '\n') break;
+        // 跳过空格
+        if (c != ' ') {
+            ungetc(c, stdin);
+        }
+    }
+    
+    // 如果用户没有选择任何交通方式，默认使用所有方式
+    if (!*allowRoad && !*allowRailway && !*allowAir) {
+        printf("No transportation modes selected. Using all modes.\n");
+        *allowRoad = *allowRailway = *allowAir = 1;
+    }
+    
+    // 显示用户选择的交通方式
+    printf("\nSelected transportation modes:");
+    if (*allowRoad) printf(" Road");
+    if (*allowRailway) printf(" Railway");
+    if (*allowAir) printf(" Air");
+    printf("\n");
+}
+
+// 读取一组城市名称并转换为节点编号，返回读取的城市个数，出错时返回-1
+int readCityList(GraphMatrix* graph, const char* prompt, int* indices, int maxCount) {
+    int count;
+    printf("Number of %s cities: ", prompt);
+    scanf("%d", &count);
+    if (count <= 0 || count > maxCount) {
+        printf("Invalid number of cities\n");
+        return -1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        char cityName[50];
+        printf("Enter %s city %d: ", prompt, i + 1);
+        scanf("%s", cityName);
+        indices[i] = findCityIndex(graph, cityName);
+        if (indices[i] == -1) {
+            printf("Error: City '%s' not found.\n", cityName);
+            return -1;
+        }
+    }
+    return count;
+}
+
+// 主函数
+int main() {
+    const char* filename = ".\\transport_data.txt";  // 使用相对路径
+    
+    printf("Loading transport data from file...\n");
+    GraphMatrix* graph = readTransportData(filename);
+    
+    if (!graph) {
+        printf("Failed to load transport data. Exiting...\n");
+        return 1;
+    }
+    
+    printf("Successfully loaded data. %d cities in the graph.\n", graph->size);
+    
+    while (1) {
+        printf("\n===== City Transport System =====\n");
+        showCities(graph);
+        
+        printf("\nPlease choose an option:\n");
+        printf("1. Find the shortest path\n");
+        printf("2. Add a city connection\n");
+        printf("3. Remove a city connection\n");
+        printf("4. Find alternative routes\n");
+        printf("5. Distance matrix between cities\n");
+        printf("6. Reachable cities within a budget\n");
+        printf("7. Exit\n");
+        
+        int choice;
+        printf("Your choice: ");
+        scanf("%d", &choice);
+        
+        if (choice == 7) {
+            break;
+        } else if (choice == 1) {
+            char startCity[50], endCity[50];
+            printf("\nEnter departure city: ");
+            scanf("%s", startCity);
+            printf("Enter destination city: ");
+            scanf("%s", endCity);
+            
+            // 查找城市索引
+            int startIndex = findCityIndex(graph, startCity);
+            int endIndex = findCityIndex(graph, endCity);
+            
+            if (startIndex == -1) {
+                printf("Error: Departure city '%s' not found.\n", startCity);
+                continue;
+            }
+            
+            if (endIndex == -1) {
+                printf("Error: Destination city '%s' not found.\n", endCity);
+                continue;
+            }
+            
+            if (startIndex == endIndex) {
+                printf("Departure and destination cities are the same.\n");
+                continue;
+            }
+            
+            // 选择搜索维度和交通方式
+            enum SearchDimension dimension = readSearchDimension();
+            int allowRoad, allowRailway, allowAir;
+            readTransportModes(&allowRoad, &allowRailway, &allowAir);
+            
+            // 不连通的城市对直接拒绝，无需搜索
+            if (!isConnected(graph, startIndex, endIndex, allowRoad, allowRailway, allowAir)) {
+                printf("No path found from %s to %s\n", graph->city[startIndex], graph->city[endIndex]);
+                continue;
+            }
+            
+            // 分配内存
+            int* dist = (int*)malloc(graph->size * sizeof(int));
+            PreInfo* pre = (PreInfo*)malloc(graph->size * sizeof(PreInfo));
+            
+            if (!dist || !pre) {
+                printf("Error: Memory allocation failed.\n");
+                free(dist);
+                free(pre);
+                continue;
+            }
+            
+            // 计算最短路径
+            dijkstra(graph, startIndex, dist, pre, allowRoad, allowRailway, allowAir, dimension);
+            
+            // 输出路径
+            printPath(graph, startIndex, endIndex, dist, pre, dimension);
+            
+            // 释放内存
+            free(dist);
+            free(pre);
+        } else if (choice == 2) {
+            // 添加城市连接
+            char startCity[50], endCity[50];
+            int modeChoice, cost, time;
             printf("\nEnter the starting city: ");
             scanf("%s", startCity);
             printf("Enter the destination city: ");
@@ -751,6 +2102,166 @@ int main() {
             }
             
             removeConnection(graph, startIndex, endIndex, mode);
+        } else if (choice == 4) {
+            // 查询多条备选路线
+            char startCity[50], endCity[50];
+            int k;
+            printf("\nEnter departure city: ");
+            scanf("%s", startCity);
+            printf("Enter destination city: ");
+            scanf("%s", endCity);
+            
+            // 查找城市索引
+            int startIndex = findCityIndex(graph, startCity);
+            int endIndex = findCityIndex(graph, endCity);
+            
+            if (startIndex == -1) {
+                printf("Error: Departure city '%s' not found.\n", startCity);
+                continue;
+            }
+            
+            if (endIndex == -1) {
+                printf("Error: Destination city '%s' not found.\n", endCity);
+                continue;
+            }
+            
+            if (startIndex == endIndex) {
+                printf("Departure and destination cities are the same.\n");
+                continue;
+            }
+            
+            printf("How many routes (K): ");
+            scanf("%d", &k);
+            if (k <= 0) {
+                printf("Invalid number of routes\n");
+                continue;
+            }
+            
+            // 选择搜索维度和交通方式
+            enum SearchDimension dimension = readSearchDimension();
+            int allowRoad, allowRailway, allowAir;
+            readTransportModes(&allowRoad, &allowRailway, &allowAir);
+            
+            RoutePath* paths = (RoutePath*)malloc(k * sizeof(RoutePath));
+            if (!paths) {
+                printf("Error: Memory allocation failed.\n");
+                continue;
+            }
+            
+            int found = kShortestPaths(graph, startIndex, endIndex, k, paths, allowRoad, allowRailway, allowAir, dimension);
+            if (found < 0) {
+                printf("Error: Memory allocation failed.\n");
+            } else if (found == 0) {
+                printf("No path found from %s to %s\n", graph->city[startIndex], graph->city[endIndex]);
+            }
+            for (int i = 0; i < found; i++) {
+                printRoutePath(graph, &paths[i], i + 1, dimension);
+                freeRoutePath(&paths[i]);
+            }
+            free(paths);
+        } else if (choice == 5) {
+            // 多对多距离矩阵查询
+            int* sources = (int*)malloc(graph->size * sizeof(int));
+            int* targets = (int*)malloc(graph->size * sizeof(int));
+            if (!sources || !targets) {
+                printf("Error: Memory allocation failed.\n");
+                free(sources);
+                free(targets);
+                continue;
+            }
+            
+            printf("\n");
+            int sourceCount = readCityList(graph, "departure", sources, graph->size);
+            int targetCount = (sourceCount > 0) ? readCityList(graph, "destination", targets, graph->size) : -1;
+            if (sourceCount <= 0 || targetCount <= 0) {
+                free(sources);
+                free(targets);
+                continue;
+            }
+            
+            // 选择搜索维度和交通方式
+            enum SearchDimension dimension = readSearchDimension();
+            int allowRoad, allowRailway, allowAir;
+            readTransportModes(&allowRoad, &allowRailway, &allowAir);
+            
+            int* matrix = (int*)malloc(sourceCount * targetCount * sizeof(int));
+            if (!matrix || distanceMatrix(graph, sources, sourceCount, targets, targetCount,
+                                          allowRoad, allowRailway, allowAir, dimension, matrix) != 0) {
+                printf("Error: Distance matrix query failed.\n");
+            } else {
+                // 输出矩阵，不可达用'-'表示
+                printf("\n%s matrix:\n%-12s", (dimension == BY_COST) ? "Cost (yuan)" : "Time (hours)", "");
+                for (int j = 0; j < targetCount; j++) {
+                    printf("%12s", graph->city[targets[j]]);
+                }
+                printf("\n");
+                for (int i = 0; i < sourceCount; i++) {
+                    printf("%-12s", graph->city[sources[i]]);
+                    for (int j = 0; j < targetCount; j++) {
+                        if (matrix[i * targetCount + j] == -1) {
+                            printf("%12s", "-");
+                        } else {
+                            printf("%12d", matrix[i * targetCount + j]);
+                        }
+                    }
+                    printf("\n");
+                }
+            }
+            
+            free(matrix);
+            free(sources);
+            free(targets);
+        } else if (choice == 6) {
+            // 预算可达查询
+            char startCity[50];
+            int budget, otherBudget;
+            printf("\nEnter departure city: ");
+            scanf("%s", startCity);
+            
+            int startIndex = findCityIndex(graph, startCity);
+            if (startIndex == -1) {
+                printf("Error: Departure city '%s' not found.\n", startCity);
+                continue;
+            }
+            
+            enum SearchDimension dimension = readSearchDimension();
+            const char* unit = (dimension == BY_COST) ? "yuan" : "hours";
+            const char* otherUnit = (dimension == BY_COST) ? "hours" : "yuan";
+            printf("Enter the budget (%s): ", unit);
+            scanf("%d", &budget);
+            printf("Enter the limit on %s (-1 for no limit): ", otherUnit);
+            scanf("%d", &otherBudget);
+            if (budget < 0 || otherBudget < -1) {
+                printf("Invalid budget\n");
+                continue;
+            }
+            
+            int allowRoad, allowRailway, allowAir;
+            readTransportModes(&allowRoad, &allowRailway, &allowAir);
+            
+            ReachInfo* reach = (ReachInfo*)malloc(graph->size * sizeof(ReachInfo));
+            if (!reach) {
+                printf("Error: Memory allocation failed.\n");
+                continue;
+            }
+            
+            int count = reachableWithinBudget(graph, startIndex, dimension, budget, otherBudget,
+                                              allowRoad, allowRailway, allowAir, reach);
+            if (count < 0) {
+                printf("Error: Reachability query failed.\n");
+            } else {
+                printf("\nCities reachable from %s within %d %s:\n", graph->city[startIndex], budget, unit);
+                // 跳过出发城市本身
+                for (int i = 1; i < count; i++) {
+                    printf("%s: %d %s, %d %s, arriving from %s (%s)\n", graph->city[reach[i].city],
+                           reach[i].value, unit, reach[i].other, otherUnit,
+                           graph->city[reach[i].pre.preVex], getTransportModeString(reach[i].pre.transportMode));
+                }
+                if (count <= 1) {
+                    printf("No other city is reachable.\n");
+                }
+            }
+            free(reach);
         } else {
             printf("Invalid choice\n");
         }